@@ -2,10 +2,10 @@
 #include <ESP8266WiFi.h>
 #include <Wire.h>
 #include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
 #include <PubSubClient.h>
 #include "config.h"
 #include "icons.h"
+#include "page_display.h"
 
 // Structs
 struct FeedingMoment 
@@ -37,14 +37,39 @@ struct FeedingMoment
     }
 };
 
+struct Statistics 
+{
+    uint32_t lastFeedingMinute;     // Minute of the year of the latest known feeding, NO_VALUE if unknown
+    uint32_t lastInterval;          // Minutes between the latest feeding and the one before, NO_VALUE if unknown
+    uint32_t intervalCount;
+    float intervalMean;             // Running mean of the intervals in minutes
+    float intervalM2;               // Running sum of squared differences from the mean (Welford)
+    uint16_t day;                   // Day of the year of today's bucket, NO_DAY if no day is known yet
+    uint8_t dayIndex;               // Position of today's bucket in dailyCounts
+    uint8_t weekCount;              // Sum of dailyCounts
+    uint8_t dailyCounts[7];         // Feedings per day for the last 7 days, as a ring buffer
+    uint8_t leapDaySeen;            // Whether 02-29 was seen since the start of the year
+};
+
+struct FeedingUndo 
+{
+    uint32_t previousMinute;        // Latest feeding minute before this feeding was added
+    uint32_t previousInterval;      // Last interval before this feeding was added
+    uint16_t day;                   // Day of the year of the bucket this feeding was counted in, NO_DAY if none was known
+    uint16_t padding;               // Extra padding for memory alignment
+};
+
 struct Memory 
 {
     uint32_t crc32;
     uint32_t lastWakeTime;
     uint32_t feedings[4];
+    FeedingUndo feedingUndo[4];     // What is needed to retract each feeding from the statistics
+    Statistics stats;
     uint8_t feedingCount;
     uint8_t pressCount;
-    uint16_t padding;       // Extra padding for memory alignment
+    int8_t lastRssi;        // RSSI of the last connection that reached MQTT in dBm, 0 if unknown
+    uint8_t wakesSinceCalibration;  // Wakes since the last full RF calibration
 };
 
 // Defenitions
@@ -54,9 +79,15 @@ struct Memory
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
-#define OLED_RESET -1
 #define SCREEN_ADDRESS 0x3C
 
+#define NO_VALUE 0xFFFFFFFF
+#define NO_DAY 0xFFFF
+#define LEAP_DAY 59
+#define MINUTES_PER_DAY 1440
+#define DAYS_PER_YEAR 366
+#define MAX_INTERVAL (7 * MINUTES_PER_DAY)
+
 // Function declarations
 uint32_t calculateCRC32(const uint8_t *data, size_t length);
 bool readMemory(Memory* data);
@@ -70,29 +101,46 @@ bool isDisplayOn();
 void waitForDisplayOff();
 void addFeedingToMemory(uint32_t dateTimeValue);
 uint32_t getLatestFeedingFromMemory();
+void updateLatestFeedingInMemory(uint32_t dateTimeValue);
 void removeLatestFeedingFromMemory();
-void clearAllFeedingsFromMemory();
-bool connectMqtt(bool drawSpinner = false);
+void clearAllFeedingsFromMemory(bool keepStatistics = false);
+uint32_t minuteOfYear(uint32_t dateTimeValue);
+uint16_t daysBetween(uint16_t fromDay, uint16_t toDay);
+uint32_t intervalBetween(uint32_t fromMinute, uint32_t toMinute);
+void advanceStatisticsDay(uint16_t day);
+void addLatestFeedingToStatistics();
+void removeLatestFeedingFromStatistics();
+float calculateTxPower(int8_t rssi);
+bool waitForWiFi();
+bool connectMqtt(bool showStatus = true);
+void receiveDateTime();
 void mqttCallback(char* topic, byte* payload, unsigned int length);
 void addFeeding();
 void removeFeeding();
 void clearFeedings();
 void printCenteredText(String text, int y);
-void drawLoadingSpinner();
+void showIcon(const unsigned char* icon);
 void print(String text);
 
 // Variables
 Memory memoryData;
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+PageDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, SCREEN_ADDRESS);
 unsigned long displayStartTime = 0;
 WiFiClient wifi;
 PubSubClient mqtt(wifi);
 uint32_t currentDateTime = 99999999;
 float currentBatteryVoltage = 0;
+float currentTxPower = TX_POWER_MAX;
+int8_t currentRssi = 0;
+
+// Runs before the PHY is initialised, so the RF calibration option applies to this boot
+RF_PRE_INIT()
+{
+    system_phy_set_powerup_option(1);  // Minimal RF during boot, only calibrate VDD33 and TX power
+}
 
 void setup()
 {
-    system_phy_set_powerup_option(1);  // Minimal RF during boot
     WiFi.mode(WIFI_OFF);               // Explicit WiFi disable
     WiFi.forceSleepBegin();            // Force radio sleep
 
@@ -128,7 +176,14 @@ void setup()
 
     // Return to deep sleep
     waitForDisplayOff();
-    ESP.deepSleep(0);
+
+    // Skip the full RF calibration on wake, except every so many wakes to correct for temperature and voltage drift
+    bool calibrate = ++memoryData.wakesSinceCalibration >= RF_CALIBRATION_INTERVAL;
+    if (calibrate)
+        memoryData.wakesSinceCalibration = 0;
+
+    writeMemory(&memoryData);
+    ESP.deepSleep(0, calibrate ? RF_CAL : RF_NO_CAL);
 }
 
 void loop() {}
@@ -150,7 +205,7 @@ void decideAction(uint8_t pressCount)
             }
             else if (RESET_AFTER_FULL && memoryData.feedingCount == 4) 
             {
-                clearAllFeedingsFromMemory();
+                clearAllFeedingsFromMemory(true);
                 updateDisplay();
             }
             
@@ -216,7 +271,7 @@ void wakeDisplay()
     delay(10);
 
     // Initialize display
-    display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS);
+    display.begin();
     
     // Update display
     updateDisplay();
@@ -226,8 +281,7 @@ void wakeDisplay()
 void turnOffDisplay() 
 {
     // Shut down display
-    display.ssd1306_command(SSD1306_DISPLAYOFF);
-    display.clearDisplay();
+    display.command(SSD1306_DISPLAYOFF);
     delay(10);
 
     // Power down OLED screen
@@ -254,83 +308,58 @@ void printCenteredText(String text, int y)
     display.print(text);
 }
 
-// Draws a rotating loading spinner
-void drawLoadingSpinner() 
+// Shows a single 48x48 icon centered on the display
+void showIcon(const unsigned char* icon) 
 {
-    // Clear display
-    display.clearDisplay();
-
-    // This creates an arc that expands and contracts while rotating
-    unsigned long currentTime = millis();
-    unsigned long cycle = currentTime % 2000;
-    float rotation = (currentTime % 1000) * 2 * PI / 1000.0;
-    
-    // Arc length changes over time
-    float arcLength;
-    if (cycle < 1000)
-        arcLength = (cycle / 1000.0) * (3 * PI / 2); // Expand from 0 to 270°
-    else
-        arcLength = ((2000 - cycle) / 1000.0) * (3 * PI / 2); // Contract back
-    
-    int numPoints = 10;
-    int radius = 15;
-    for (int i = 0; i < numPoints; i++)
+    display.firstPage();
+    do 
     {
-        float angle = rotation + (arcLength * i / numPoints);
-        
-        int x = 64 + radius * cos(angle);
-        int y = 32 + radius * sin(angle);
-        
-        // Draw 2-pixel thick line
-        display.drawPixel(x, y, SSD1306_WHITE);
-        display.drawPixel(x + 1, y, SSD1306_WHITE);
-        display.drawPixel(x, y + 1, SSD1306_WHITE);
-        display.drawPixel(x + 1, y + 1, SSD1306_WHITE);
-    }
-
-    // Show to display
-    display.display();
+        display.drawBitmap(40, 8, icon, 48, 48, SSD1306_WHITE);
+    } 
+    while (display.nextPage());
 }
 
 // Updates the display information
 void updateDisplay() 
 {
-    // Clear buffer
-    display.clearDisplay();
-    
     // Set text color
     display.setTextColor(SSD1306_WHITE);
     
     // Retrieve latest feeding
     FeedingMoment latestMoment;
     latestMoment.dateTimeValue = getLatestFeedingFromMemory();
+    String timeString = latestMoment.timeString();
+    String dateString = latestMoment.dateString();
 
-    // Print information
-    if (memoryData.feedingCount == 0) 
+    // Draw the screen page by page
+    display.firstPage();
+    do 
     {
-        // If feeding count is 0, print no food icon
-        display.drawBitmap(40, 8, no_food_icon, 48, 48, SSD1306_WHITE);
-    }
-    else 
-    {
-        // Print food icon the same amount of times as feeding count
-        int startPoint = 64 - (memoryData.feedingCount * 16);
-        for (int i = 0; i < memoryData.feedingCount; i++) 
+        // Print information
+        if (memoryData.feedingCount == 0) 
         {
-            display.drawBitmap(i * 32 + startPoint, 0, food_icon, 32, 32, SSD1306_WHITE);
+            // If feeding count is 0, print no food icon
+            display.drawBitmap(40, 8, no_food_icon, 48, 48, SSD1306_WHITE);
         }
-        
-        // Print lastest time
-        display.setTextSize(2);
-        printCenteredText(latestMoment.timeString(), 38);
-        
-        // Print lastest date
-        display.setTextSize(1);
-        printCenteredText(latestMoment.dateString(), 57);
-    }
-
-    // Put on display
-    display.display();
+        else 
+        {
+            // Print food icon the same amount of times as feeding count
+            int startPoint = 64 - (memoryData.feedingCount * 16);
+            for (int i = 0; i < memoryData.feedingCount; i++) 
+            {
+                display.drawBitmap(i * 32 + startPoint, 0, food_icon, 32, 32, SSD1306_WHITE);
+            }
+            
+            // Print lastest time
+            display.setTextSize(2);
+            printCenteredText(timeString, 38);
+            
+            // Print lastest date
+            display.setTextSize(1);
+            printCenteredText(dateString, 57);
+        }
+    } 
+    while (display.nextPage());
 
     // Start display timer
     displayStartTime = millis();
@@ -365,13 +394,18 @@ void addFeedingToMemory(uint32_t dateTimeValue)
 
     // Shift existing feedings right
     for (int i = 3; i > 0; i--)
+    {
         memoryData.feedings[i] = memoryData.feedings[i - 1];
+        memoryData.feedingUndo[i] = memoryData.feedingUndo[i - 1];
+    }
     
     // Add new feedings at front
     memoryData.feedings[0] = dateTimeValue;
     if (memoryData.feedingCount < 4)
         memoryData.feedingCount++;
 
+    addLatestFeedingToStatistics();
+
     writeMemory(&memoryData);
 }
 
@@ -384,35 +418,253 @@ uint32_t getLatestFeedingFromMemory()
     return 99999999;
 }
 
+// Replace the time of the latest feeding moment
+void updateLatestFeedingInMemory(uint32_t dateTimeValue) 
+{
+    if (memoryData.feedingCount == 0)
+        return;
+
+    // Replace the contribution of the old time in the statistics
+    removeLatestFeedingFromStatistics();
+    memoryData.feedings[0] = dateTimeValue;
+    addLatestFeedingToStatistics();
+
+    writeMemory(&memoryData);
+}
+
 // Remove the latest feeding moment
 void removeLatestFeedingFromMemory() 
 {
     if (memoryData.feedingCount == 0)
         return;
+
+    // Retract the feeding from the statistics
+    removeLatestFeedingFromStatistics();
         
     // Shift everything left
     for (int i = 0; i < 3; i++)
+    {
         memoryData.feedings[i] = memoryData.feedings[i + 1];
+        memoryData.feedingUndo[i] = memoryData.feedingUndo[i + 1];
+    }
 
     memoryData.feedingCount--;
     memoryData.feedings[memoryData.feedingCount] = 0;
+    memoryData.feedingUndo[memoryData.feedingCount] = { NO_VALUE, NO_VALUE, NO_DAY, 0 };
 
     writeMemory(&memoryData);
 }
 
-// Clears all feeding records
-void clearAllFeedingsFromMemory() 
+// Clears all feeding records, keepStatistics is used for automatic resets where the feedings did happen
+void clearAllFeedingsFromMemory(bool keepStatistics) 
 {
+    // Retract the cleared feedings latest first, this is at most 4 removals
+    if (!keepStatistics)
+    {
+        while (memoryData.feedingCount > 0)
+            removeLatestFeedingFromMemory();
+    }
+
     memoryData.feedingCount = 0;
 
     for (int i = 0; i < 4; i++)
+    {
         memoryData.feedings[i] = 0;
+        memoryData.feedingUndo[i] = { NO_VALUE, NO_VALUE, NO_DAY, 0 };
+    }
 
     writeMemory(&memoryData);
 }
 
-// Connects to WiFi and MQTT
-bool connectMqtt(bool drawSpinner) 
+// Converts a MMDDhhmm value to the minute of the year, NO_VALUE if the time is unknown
+uint32_t minuteOfYear(uint32_t dateTimeValue) 
+{
+    // 02-29 gets its own day, daysBetween skips it again in years where it is not seen
+    static const uint16_t daysBeforeMonth[12] = { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335 };
+
+    uint16_t date = dateTimeValue / 10000;
+    uint16_t time = dateTimeValue % 10000;
+    uint8_t month = date / 100;
+    uint8_t day = date % 100;
+
+    if (month < 1 || month > 12 || day < 1 || day > 31 || time / 100 > 23 || time % 100 > 59)
+        return NO_VALUE;
+
+    return (daysBeforeMonth[month - 1] + day - 1) * MINUTES_PER_DAY + (time / 100) * 60 + time % 100;
+}
+
+// Calculates the days from one day of the year to another, going forward and wrapping around the year
+uint16_t daysBetween(uint16_t fromDay, uint16_t toDay) 
+{
+    uint16_t days = (toDay + DAYS_PER_YEAR - fromDay) % DAYS_PER_YEAR;
+
+    // The year is not known, so stepping over 02-29 without seeing it is treated as a year without 02-29
+    uint16_t daysToLeapDay = (LEAP_DAY + DAYS_PER_YEAR - fromDay) % DAYS_PER_YEAR;
+    if (!memoryData.stats.leapDaySeen && daysToLeapDay > 0 && daysToLeapDay < days)
+        days--;
+
+    return days;
+}
+
+// Calculates the minutes between two feedings, NO_VALUE if either is unknown or the gap is not a sane interval
+uint32_t intervalBetween(uint32_t fromMinute, uint32_t toMinute) 
+{
+    if (fromMinute == NO_VALUE || toMinute == NO_VALUE)
+        return NO_VALUE;
+
+    // Whole days plus the difference in time of day, this can be negative within the first day
+    int32_t interval = (int32_t)daysBetween(fromMinute / MINUTES_PER_DAY, toMinute / MINUTES_PER_DAY) * MINUTES_PER_DAY
+        + (int32_t)(toMinute % MINUTES_PER_DAY) - (int32_t)(fromMinute % MINUTES_PER_DAY);
+
+    // Also rejects backwards timestamps, since those are negative or wrap around to almost a year
+    if (interval < 0 || interval > MAX_INTERVAL)
+        return NO_VALUE;
+
+    return interval;
+}
+
+// Moves today's bucket forward to the given day of the year, emptying the days that passed
+void advanceStatisticsDay(uint16_t day) 
+{
+    Statistics &stats = memoryData.stats;
+
+    // Remember if 02-29 exists this year, a day before it means a new year has started
+    if (day == LEAP_DAY)
+        stats.leapDaySeen = true;
+    else if (day < LEAP_DAY)
+        stats.leapDaySeen = false;
+
+    // The first known day is taken as is, with empty buckets
+    if (stats.day == NO_DAY) 
+    {
+        memset(stats.dailyCounts, 0, sizeof(stats.dailyCounts));
+        stats.weekCount = 0;
+        stats.dayIndex = 0;
+        stats.day = day;
+        return;
+    }
+
+    uint16_t daysPassed = daysBetween(stats.day, day);
+
+    // A day up to a month before today's bucket is a backwards timestamp, never move back to it
+    if (daysPassed > DAYS_PER_YEAR - 31)
+        return;
+
+    // At most 7 buckets have to be emptied, so this stays constant time
+    for (uint16_t i = 0; i < daysPassed && i < 7; i++)
+    {
+        stats.dayIndex = (stats.dayIndex + 1) % 7;
+        stats.weekCount -= stats.dailyCounts[stats.dayIndex];
+        stats.dailyCounts[stats.dayIndex] = 0;
+    }
+
+    stats.day = day;
+}
+
+// Adds the latest feeding to the running statistics and remembers what is needed to retract it
+void addLatestFeedingToStatistics() 
+{
+    Statistics &stats = memoryData.stats;
+    FeedingUndo &undo = memoryData.feedingUndo[0];
+    uint32_t minute = minuteOfYear(memoryData.feedings[0]);
+
+    // A feeding with unknown time is counted for the current day
+    if (minute != NO_VALUE)
+        advanceStatisticsDay(minute / MINUTES_PER_DAY);
+
+    undo.previousMinute = stats.lastFeedingMinute;
+    undo.previousInterval = stats.lastInterval;
+    undo.day = stats.day;
+    stats.dailyCounts[stats.dayIndex]++;
+    stats.weekCount++;
+
+    // Update mean and variance with the new interval (Welford)
+    uint32_t interval = intervalBetween(stats.lastFeedingMinute, minute);
+    if (interval != NO_VALUE) 
+    {
+        stats.intervalCount++;
+        float delta = interval - stats.intervalMean;
+        stats.intervalMean += delta / stats.intervalCount;
+        stats.intervalM2 += delta * (interval - stats.intervalMean);
+    }
+
+    // An unknown time breaks the chain, so no interval is recorded across it
+    stats.lastFeedingMinute = minute;
+    stats.lastInterval = interval;
+}
+
+// Retracts the latest feeding from the running statistics
+void removeLatestFeedingFromStatistics() 
+{
+    Statistics &stats = memoryData.stats;
+    FeedingUndo &undo = memoryData.feedingUndo[0];
+
+    // Remove it from its day bucket if that day is still within the last 7 days
+    // Feedings counted before the first known day were dropped when that day became known
+    if (undo.day != NO_DAY || stats.day == NO_DAY) 
+    {
+        uint16_t age = undo.day == NO_DAY ? 0 : daysBetween(undo.day, stats.day);
+        if (age < 7) 
+        {
+            uint8_t index = (stats.dayIndex + 7 - age) % 7;
+            if (stats.dailyCounts[index] > 0) 
+            {
+                stats.dailyCounts[index]--;
+                stats.weekCount--;
+            }
+        }
+    }
+
+    // The latest feeding is the one that set the last interval, undo it in mean and variance (reverse Welford)
+    uint32_t interval = stats.lastInterval;
+    if (interval != NO_VALUE && stats.intervalCount > 0) 
+    {
+        if (stats.intervalCount == 1) 
+        {
+            stats.intervalMean = 0;
+            stats.intervalM2 = 0;
+        }
+        else 
+        {
+            float previousMean = (stats.intervalMean * stats.intervalCount - interval) / (stats.intervalCount - 1);
+            stats.intervalM2 -= (interval - stats.intervalMean) * (interval - previousMean);
+            stats.intervalMean = previousMean;
+
+            if (stats.intervalM2 < 0)
+                stats.intervalM2 = 0;
+        }
+
+        stats.intervalCount--;
+    }
+
+    // The feeding before this one becomes the latest feeding again
+    stats.lastFeedingMinute = undo.previousMinute;
+    stats.lastInterval = undo.previousInterval;
+}
+
+// Calculates the lowest transmit power in dBm that keeps the link above the RSSI target, full power if the RSSI is unknown
+float calculateTxPower(int8_t rssi) 
+{
+    if (rssi == 0)
+        return TX_POWER_MAX;
+
+    // The path loss is roughly symmetric, so every dB of margin above the target is a dB we can transmit less
+    float power = TX_POWER_MAX - (rssi - RSSI_TARGET);
+    return constrain(power, TX_POWER_MIN, TX_POWER_MAX);
+}
+
+// Waits for the WiFi connection with timeout
+bool waitForWiFi() 
+{
+    unsigned long start = millis();
+    while (WiFi.status() != WL_CONNECTED && millis() - start < WIFI_TIMEOUT) 
+        delay(1);
+
+    return WiFi.status() == WL_CONNECTED;
+}
+
+// Connects to WiFi and MQTT, optionally showing the connection result on screen
+bool connectMqtt(bool showStatus) 
 {
     print("Connecting to MQTT...");
     // First read battery voltage, since WiFi can create noise on the analog input
@@ -421,6 +673,11 @@ bool connectMqtt(bool drawSpinner)
     // Enable WiFi
     WiFi.forceSleepWake();
     WiFi.mode(WIFI_STA);
+
+    // Use the transmit power that kept the link healthy last time
+    currentTxPower = calculateTxPower(memoryData.lastRssi);
+    WiFi.setOutputPower(currentTxPower);
+    print("TX power: " + String(currentTxPower) + " dBm");
     
     // Configure static IP if provided
     if (strlen(STATIC_IP) > 0) 
@@ -435,36 +692,48 @@ bool connectMqtt(bool drawSpinner)
     }
 
     WiFi.begin(WIFI_SSID, WIFI_PASS);
+    bool linked = waitForWiFi();
 
-    // Wait for connection with 10 sec timeout
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - start < WIFI_TIMEOUT) 
+    // If the lowered transmit power was not enough, retry once at full power
+    if (!linked && currentTxPower < TX_POWER_MAX) 
     {
-        if (drawSpinner)
-            drawLoadingSpinner();
-            
-        delay(1);
+        print("Retrying at full TX power");
+        currentTxPower = TX_POWER_MAX;
+        WiFi.setOutputPower(currentTxPower);
+        WiFi.begin(WIFI_SSID, WIFI_PASS);
+        linked = waitForWiFi();
     }
         
     // If we failed to connect after timeout return
-    if (WiFi.status() != WL_CONNECTED) 
+    if (!linked) 
     {   
+        // Fall back to full transmit power next time
+        memoryData.lastRssi = 0;
+        writeMemory(&memoryData);
+
         // Show connection failed icon
-        display.clearDisplay();
-        display.drawBitmap(40, 8, connection_failed_icon, 48, 48, SSD1306_WHITE);
-        display.display();
-        delay(3000);
+        if (showStatus)
+        {
+            showIcon(connection_failed_icon);
+            delay(3000);
+        }
+
         return false;
     }
+
+    currentRssi = WiFi.RSSI();
+    print("RSSI: " + String(currentRssi) + " dBm");
     
     // Show connection successful icon
-    display.clearDisplay();
-    display.drawBitmap(40, 8, connection_success_icon, 48, 48, SSD1306_WHITE);
-    display.display();
+    if (showStatus)
+    {
+        showIcon(connection_success_icon);
+    }
 
     // Set up MQTT
     mqtt.setServer(MQTT_SERVER, MQTT_PORT);
     mqtt.setCallback(mqttCallback);
+    mqtt.setBufferSize(512);    // Room for the status payload with statistics
     
     // Connect to MQTT (with authentication if present)
     bool connected = false;
@@ -476,6 +745,10 @@ bool connectMqtt(bool drawSpinner)
 
     print("Connection successfull: " + String(connected));
 
+    // Only keep the link quality if the link was healthy all the way to MQTT, otherwise fall back to full power next time
+    memoryData.lastRssi = connected ? currentRssi : 0;
+    writeMemory(&memoryData);
+
     return connected;
 }
 
@@ -502,6 +775,21 @@ void mqttCallback(char* topic, byte* payload, unsigned int length)
     print("Received datetime: " + String(currentDateTime));
 }
 
+// Waits for the retained datetime message
+void receiveDateTime() 
+{
+    // Subscribe to the time topic
+    mqtt.subscribe(MQTT_RECV);
+    
+    // Wait for the retained message with 3 sec timeout
+    unsigned long start = millis();
+    while (millis() - start < MQTT_TIMEOUT && currentDateTime == 99999999) 
+    {
+        mqtt.loop();
+        yield();
+    }
+}
+
 // Sends the latest data over MQTT
 void sendUpdate() 
 {
@@ -509,42 +797,73 @@ void sendUpdate()
     {
         print("Sending update...");
 
-        String json = "{\"count\":" + String(memoryData.feedingCount) + ", \"datetime\":" + String(getLatestFeedingFromMemory()) + ", \"battery-voltage\":" + String(currentBatteryVoltage) + "}";
+        // Move today's bucket to the current day, so the counts are not stale after midnight
+        uint32_t currentMinute = minuteOfYear(currentDateTime);
+        if (currentMinute != NO_VALUE) 
+        {
+            advanceStatisticsDay(currentMinute / MINUTES_PER_DAY);
+            writeMemory(&memoryData);
+        }
+
+        Statistics &stats = memoryData.stats;
+        String lastInterval = stats.lastInterval != NO_VALUE ? String(stats.lastInterval) : "null";
+        float intervalVariance = stats.intervalCount > 0 ? stats.intervalM2 / stats.intervalCount : 0;
+
+        String json = "{\"count\":" + String(memoryData.feedingCount) + ", \"datetime\":" + String(getLatestFeedingFromMemory()) + ", \"battery-voltage\":" + String(currentBatteryVoltage) + ", \"rssi\":" + String(currentRssi) + ", \"tx-power\":" + String(currentTxPower)
+            + ", \"today-count\":" + String(stats.dailyCounts[stats.dayIndex]) + ", \"week-count\":" + String(stats.weekCount)
+            + ", \"last-interval\":" + lastInterval + ", \"interval-mean\":" + String(stats.intervalMean) + ", \"interval-variance\":" + String(intervalVariance) + "}";
 
         mqtt.publish(MQTT_SEND, json.c_str(), true);
     }
 }
 
-// Adds a feeding moment, both synced to MQTT and to memory
+// Adds a feeding moment, shown immediately and synced to MQTT afterwards
 void addFeeding() 
 {
     print("Adding feeding...");
 
-    // Try to connect to MQTT
-    bool connected = connectMqtt(true);
-    if (connected)
+    // Remember the state before adding, needed to resolve a day change once the time is known
+    uint8_t previousCount = memoryData.feedingCount;
+    uint32_t previousFeeding = getLatestFeedingFromMemory();
+
+    // Add feeding with unknown time to memory and show it right away
+    addFeedingToMemory(99999999);
+    updateDisplay();
+
+    // Try to connect to MQTT without covering the updated screen
+    if (connectMqtt(false))
     {
-        // Subscribe to the time topic
-        mqtt.subscribe(MQTT_RECV);
-        
-        // Wait for the retained message with 3 sec timeout
-        unsigned long start = millis();
-        while (millis() - start < MQTT_TIMEOUT && currentDateTime == 99999999) 
-        {
-            mqtt.loop();
-            yield();
-        }
+        receiveDateTime();
+    }
+    else
+    {
+        // Briefly show the connection failed icon, so it is clear the time could not be filled in
+        showIcon(connection_failed_icon);
+        delay(1000);
+        updateDisplay();
     }
     
-    // Check if current date is still as last feeding date, if not reset feedings
-    if (memoryData.feedingCount > 0 && getLatestFeedingFromMemory() != 99999999 && currentDateTime != 99999999 && currentDateTime / 10000 != getLatestFeedingFromMemory() / 10000)
-        clearAllFeedingsFromMemory();
+    // Fill in the actual time of the new feeding once it is known
+    if (currentDateTime != 99999999)
+    {
+        // Check if current date is still as last feeding date, if not reset feedings
+        if (previousCount > 0 && previousFeeding != 99999999 && currentDateTime / 10000 != previousFeeding / 10000)
+        {
+            // Retract the feeding with unknown time, so only the one with the actual time is counted
+            if (previousCount < 4)
+                removeLatestFeedingFromMemory();
 
-    // Add feeding with current time to memory
-    addFeedingToMemory(currentDateTime);
-    
-    // Update the display
-    updateDisplay();
+            clearAllFeedingsFromMemory(true);
+            addFeedingToMemory(currentDateTime);
+        }
+        else if (previousCount < 4)
+        {
+            updateLatestFeedingInMemory(currentDateTime);
+        }
+
+        // Update the display
+        updateDisplay();
+    }
     
     // Send update over MQTT
     sendUpdate();
@@ -573,7 +892,10 @@ void removeFeeding()
     
     // Try to connect to MQTT and send update
     if (connectMqtt())
+    {
+        receiveDateTime();
         sendUpdate();
+    }
         
     // Disconnect MQTT
     disconnectMqtt();
@@ -595,7 +917,10 @@ void clearFeedings()
     
     // Try to connect to MQTT and send update
     if (connectMqtt())
+    {
+        receiveDateTime();
         sendUpdate();
+    }
         
     // Disconnect MQTT
     disconnectMqtt();
@@ -614,6 +939,12 @@ bool readMemory(Memory* data)
     
     // Initialize with defaults if invalid
     memset(data, 0, sizeof(Memory));
+    data->stats.lastFeedingMinute = NO_VALUE;
+    data->stats.lastInterval = NO_VALUE;
+    data->stats.day = NO_DAY;
+
+    for (int i = 0; i < 4; i++)
+        data->feedingUndo[i] = { NO_VALUE, NO_VALUE, NO_DAY, 0 };
 
     return false;
 }
@@ -0,0 +1,131 @@
+#ifndef PAGE_DISPLAY_H
+#define PAGE_DISPLAY_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+// SSD1306 driver that renders one 8-row page at a time into a 128 byte buffer instead of keeping a full framebuffer.
+// Every frame is drawn once per page, use it like this:
+//
+//     display.firstPage();
+//     do {
+//         ...draw calls...
+//     } while (display.nextPage());
+class PageDisplay : public Adafruit_GFX
+{
+public:
+    static const int16_t PAGE_HEIGHT = 8;
+    static const int16_t MAX_WIDTH = 128;
+
+    PageDisplay(int16_t width, int16_t height, TwoWire *wire, uint8_t address)
+        : Adafruit_GFX(width, height), wire(wire), address(address), page(0)
+    {
+        memset(buffer, 0, sizeof(buffer));
+    }
+
+    // Initializes the display, same sequence as Adafruit_SSD1306::begin with SSD1306_SWITCHCAPVCC
+    void begin()
+    {
+        wire->begin();
+        wire->setClock(400000);
+
+        const uint8_t init[] = {
+            SSD1306_DISPLAYOFF,
+            SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+            SSD1306_SETMULTIPLEX, (uint8_t)(HEIGHT - 1),
+            SSD1306_SETDISPLAYOFFSET, 0x00,
+            SSD1306_SETSTARTLINE | 0x00,
+            SSD1306_CHARGEPUMP, 0x14,
+            SSD1306_MEMORYMODE, 0x00,
+            SSD1306_SEGREMAP | 0x01,
+            SSD1306_COMSCANDEC,
+            SSD1306_SETCOMPINS, (uint8_t)(HEIGHT == 64 ? 0x12 : 0x02),
+            SSD1306_SETCONTRAST, 0xCF,
+            SSD1306_SETPRECHARGE, 0xF1,
+            SSD1306_SETVCOMDETECT, 0x40,
+            SSD1306_DISPLAYALLON_RESUME,
+            SSD1306_NORMALDISPLAY,
+            SSD1306_DEACTIVATE_SCROLL,
+            SSD1306_DISPLAYON
+        };
+
+        for (size_t i = 0; i < sizeof(init); i++)
+            command(init[i]);
+    }
+
+    // Sends a single command byte
+    void command(uint8_t c)
+    {
+        wire->beginTransmission(address);
+        wire->write((uint8_t)0x00);
+        wire->write(c);
+        wire->endTransmission();
+    }
+
+    // Starts a new frame at the top page
+    void firstPage()
+    {
+        page = 0;
+        memset(buffer, 0, sizeof(buffer));
+    }
+
+    // Sends the current page to the display and moves to the next one, returns false when the frame is complete
+    bool nextPage()
+    {
+        flushPage();
+
+        page++;
+        if (page * PAGE_HEIGHT >= HEIGHT)
+            return false;
+
+        memset(buffer, 0, sizeof(buffer));
+        return true;
+    }
+
+    // Only pixels inside the current page are stored, everything else is drawn again for its own page
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+        int16_t top = page * PAGE_HEIGHT;
+        if (x < 0 || x >= WIDTH || y < top || y >= top + PAGE_HEIGHT)
+            return;
+
+        uint8_t bit = 1 << (y - top);
+        switch (color)
+        {
+            case SSD1306_WHITE:   buffer[x] |= bit;  break;
+            case SSD1306_BLACK:   buffer[x] &= ~bit; break;
+            case SSD1306_INVERSE: buffer[x] ^= bit;  break;
+        }
+    }
+
+private:
+    static const uint8_t CHUNK_SIZE = 16;   // Stays well within the Wire buffer including the control byte
+
+    TwoWire *wire;
+    uint8_t address;
+    uint8_t page;
+    uint8_t buffer[MAX_WIDTH];
+
+    // Streams the page buffer to the display RAM
+    void flushPage()
+    {
+        command(SSD1306_PAGEADDR);
+        command(page);
+        command(page);
+        command(SSD1306_COLUMNADDR);
+        command(0);
+        command(WIDTH - 1);
+
+        for (int16_t x = 0; x < WIDTH; x += CHUNK_SIZE)
+        {
+            wire->beginTransmission(address);
+            wire->write((uint8_t)0x40);
+            wire->write(&buffer[x], min((int16_t)CHUNK_SIZE, (int16_t)(WIDTH - x)));
+            wire->endTransmission();
+        }
+    }
+};
+
+#endif